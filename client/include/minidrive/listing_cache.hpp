@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace minidrive {
+
+struct RemoteEntry {
+    std::string name;
+    bool is_directory = false;
+    std::uint64_t size = 0;
+};
+
+struct Listing {
+    std::uint64_t version = 0; // server-side version stamp of the directory
+    std::vector<RemoteEntry> entries;
+    std::chrono::steady_clock::time_point validated;
+};
+
+// Thread-safe cache of remote directory listings, keyed by absolute remote
+// path ("/", "/docs"). Shared by the shell and the background prefetcher.
+//
+// Listings are served straight from the cache whatever their age
+// (stale-while-revalidate). One validated more than max_age ago is then
+// revalidated in the background by sending its version back to the server,
+// which answers "not modified" unless the directory changed.
+class ListingCache {
+public:
+    explicit ListingCache(std::chrono::milliseconds max_age);
+
+    std::optional<Listing> get(const std::string& path) const;
+    // Whether a listing obtained from get() was validated within max_age.
+    bool is_fresh(const Listing& listing) const;
+
+    void put(const std::string& path, Listing listing);
+    // Marks a listing as confirmed unchanged by the server.
+    void revalidated(const std::string& path);
+    // Drops the listing of `path` only.
+    void invalidate(const std::string& path);
+    // Drops the listing of `path` and of everything below it.
+    void invalidate_tree(const std::string& path);
+
+    // Looks `path` up in its parent's cached listing.
+    std::optional<RemoteEntry> stat(const std::string& path) const;
+
+    // Names in the cached listing of `directory` starting with `prefix`.
+    std::vector<RemoteEntry> complete(const std::string& directory, const std::string& prefix) const;
+
+private:
+    std::chrono::milliseconds max_age_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Listing> listings_;
+};
+
+// Resolves `path` against the remote working directory `cwd` into a normalised
+// absolute path. Throws std::invalid_argument if it climbs above the root.
+std::string resolve_remote_path(const std::string& cwd, const std::string& path);
+
+// "/a/b" -> "/a", "/a" -> "/", "/" -> "/".
+std::string remote_parent(const std::string& path);
+
+// Joins a directory and a child name: ("/", "a") -> "/a", ("/a", "b") -> "/a/b".
+std::string remote_child(const std::string& directory, const std::string& name);
+
+} // namespace minidrive
@@ -0,0 +1,134 @@
+#include "minidrive/listing_cache.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace minidrive {
+
+ListingCache::ListingCache(std::chrono::milliseconds max_age) : max_age_(max_age) {}
+
+std::optional<Listing> ListingCache::get(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(path);
+    if (it == listings_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool ListingCache::is_fresh(const Listing& listing) const {
+    return std::chrono::steady_clock::now() - listing.validated < max_age_;
+}
+
+void ListingCache::put(const std::string& path, Listing listing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listing.validated = std::chrono::steady_clock::now();
+    listings_[path] = std::move(listing);
+}
+
+void ListingCache::revalidated(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(path);
+    if (it != listings_.end()) {
+        it->second.validated = std::chrono::steady_clock::now();
+    }
+}
+
+void ListingCache::invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listings_.erase(path);
+}
+
+void ListingCache::invalidate_tree(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto prefix = path == "/" ? path : path + "/";
+    for (auto it = listings_.begin(); it != listings_.end();) {
+        if (it->first == path || it->first.rfind(prefix, 0) == 0) {
+            it = listings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::optional<RemoteEntry> ListingCache::stat(const std::string& path) const {
+    if (path == "/") {
+        return RemoteEntry{"/", true, 0};
+    }
+    auto parent = remote_parent(path);
+    auto name = path.substr(parent.size() + (parent == "/" ? 0 : 1));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(parent);
+    if (it == listings_.end()) {
+        return std::nullopt;
+    }
+    for (const auto& entry : it->second.entries) {
+        if (entry.name == name) {
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<RemoteEntry> ListingCache::complete(const std::string& directory, const std::string& prefix) const {
+    std::vector<RemoteEntry> matches;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = listings_.find(directory);
+    if (it == listings_.end()) {
+        return matches;
+    }
+    for (const auto& entry : it->second.entries) {
+        if (entry.name.rfind(prefix, 0) == 0) {
+            matches.push_back(entry);
+        }
+    }
+    return matches;
+}
+
+std::string resolve_remote_path(const std::string& cwd, const std::string& path) {
+    std::vector<std::string> parts;
+    auto push_components = [&parts, &path](const std::string& source) {
+        std::istringstream stream(source);
+        std::string part;
+        while (std::getline(stream, part, '/')) {
+            if (part.empty() || part == ".") {
+                continue;
+            }
+            if (part == "..") {
+                if (parts.empty()) {
+                    throw std::invalid_argument("Path escapes the root directory: " + path);
+                }
+                parts.pop_back();
+            } else {
+                parts.push_back(part);
+            }
+        }
+    };
+
+    if (path.empty() || path.front() != '/') {
+        push_components(cwd);
+    }
+    push_components(path);
+
+    std::string resolved;
+    for (const auto& part : parts) {
+        resolved += "/" + part;
+    }
+    return resolved.empty() ? "/" : resolved;
+}
+
+std::string remote_parent(const std::string& path) {
+    auto slash = path.rfind('/');
+    if (slash == std::string::npos || slash == 0) {
+        return "/";
+    }
+    return path.substr(0, slash);
+}
+
+std::string remote_child(const std::string& directory, const std::string& name) {
+    return directory == "/" ? "/" + name : directory + "/" + name;
+}
+
+} // namespace minidrive
@@ -1,13 +1,29 @@
 #include <iostream>
 #include <regex>
 #include <string>
+#include "minidrive/listing_cache.hpp"
 #include "minidrive/version.hpp"
+#include <algorithm>
 #include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <nlohmann/json.hpp>
+#include <csignal>
+#include <termios.h>
+#include <unistd.h>
 
 using json = nlohmann::json;
 
+// Age after which a cached listing, still served at once, is revalidated in the background.
+constexpr std::chrono::seconds listing_max_age{2};
+
 bool parse_arguments(int argc, char* argv[], std::string& connection, std::string& log_file) {
     if (argc < 2 || argc > 4) {
         std::cerr << "Usage: " << argv[0] << " [username@]<server_ip>:<port> [--log <log_file>]\n";
@@ -111,7 +127,9 @@ bool validate_command(const std::string& input) {
     return false; // Unknown command
 }
 
-std::string create_json_command(const std::string& input) {
+// Remote paths are resolved against the client's working directory, so the
+// server always receives absolute paths.
+std::string create_json_command(const std::string& input, const std::string& cwd) {
     std::istringstream iss(input);
     std::string command;
     iss >> command;
@@ -122,28 +140,30 @@ std::string create_json_command(const std::string& input) {
     if (command == "LIST") {
         std::string path;
         if (iss >> path) {
-            json_command["args"]["path"] = path;
+            json_command["args"]["path"] = minidrive::resolve_remote_path(cwd, path);
         } else {
-            json_command["args"]["path"] = "."; // Default to current directory
+            json_command["args"]["path"] = cwd; // Default to current directory
         }
     } else if (command == "UPLOAD" || command == "DOWNLOAD") {
         std::string first_arg, second_arg;
         if (iss >> first_arg) {
-            json_command["args"][command == "UPLOAD" ? "local_path" : "remote_path"] = first_arg;
+            json_command["args"][command == "UPLOAD" ? "local_path" : "remote_path"] =
+                command == "UPLOAD" ? first_arg : minidrive::resolve_remote_path(cwd, first_arg);
             if (iss >> second_arg) {
-                json_command["args"][command == "UPLOAD" ? "remote_path" : "local_path"] = second_arg;
+                json_command["args"][command == "UPLOAD" ? "remote_path" : "local_path"] =
+                    command == "UPLOAD" ? minidrive::resolve_remote_path(cwd, second_arg) : second_arg;
             }
         }
     } else if (command == "DELETE" || command == "CD" || command == "MKDIR" || command == "RMDIR") {
         std::string path;
         if (iss >> path) {
-            json_command["args"]["path"] = path;
+            json_command["args"]["path"] = minidrive::resolve_remote_path(cwd, path);
         }
     } else if (command == "MOVE" || command == "COPY") {
         std::string src, dst;
         if (iss >> src >> dst) {
-            json_command["args"]["src"] = src;
-            json_command["args"]["dst"] = dst;
+            json_command["args"]["src"] = minidrive::resolve_remote_path(cwd, src);
+            json_command["args"]["dst"] = minidrive::resolve_remote_path(cwd, dst);
         }
     }
 
@@ -154,7 +174,231 @@ void log_debug(const std::string& message) {
     std::cout << "[DEBUG] " << message << "\n";
 }
 
-void upload_file(asio::ip::tcp::socket& socket, const std::string& local_path, const std::string& remote_path) {
+// The control connection is shared by the shell and the background
+// prefetcher; every request/response exchange takes a ConnectionTurn.
+struct Session {
+    explicit Session(asio::ip::tcp::socket& socket) : socket(socket) {}
+
+    asio::ip::tcp::socket& socket;
+    std::mutex mutex;
+    std::condition_variable idle;
+    bool busy = false;
+    std::size_t foreground_waiting = 0;
+    std::atomic<std::size_t> round_trips{0};
+    std::atomic<std::size_t> prefetch_round_trips{0};
+};
+
+// Exclusive use of the connection for one exchange. The shell goes first:
+// a prefetch does not start while a foreground request is waiting.
+class ConnectionTurn {
+public:
+    ConnectionTurn(Session& session, bool prefetch) : session_(session) {
+        std::unique_lock<std::mutex> lock(session_.mutex);
+        if (prefetch) {
+            session_.idle.wait(lock, [this]() { return !session_.busy && session_.foreground_waiting == 0; });
+        } else {
+            ++session_.foreground_waiting;
+            session_.idle.wait(lock, [this]() { return !session_.busy; });
+            --session_.foreground_waiting;
+        }
+        session_.busy = true;
+    }
+
+    ~ConnectionTurn() {
+        {
+            std::lock_guard<std::mutex> lock(session_.mutex);
+            session_.busy = false;
+        }
+        session_.idle.notify_all();
+    }
+
+    ConnectionTurn(const ConnectionTurn&) = delete;
+    ConnectionTurn& operator=(const ConnectionTurn&) = delete;
+
+private:
+    Session& session_;
+};
+
+// One request/response exchange; the caller holds a ConnectionTurn.
+json exchange(Session& session, const json& command, bool prefetch) {
+    asio::write(session.socket, asio::buffer(command.dump() + "\n"));
+
+    asio::streambuf buffer;
+    asio::read_until(session.socket, buffer, '\n');
+    std::istream response_stream(&buffer);
+    std::string response_message;
+    std::getline(response_stream, response_message);
+
+    ++(prefetch ? session.prefetch_round_trips : session.round_trips);
+    return json::parse(response_message);
+}
+
+json send_request(Session& session, const json& command, bool prefetch = false) {
+    ConnectionTurn turn(session, prefetch);
+    return exchange(session, command, prefetch);
+}
+
+void print_response(const json& response) {
+    if (response.value("status", "") == "success") {
+        std::cout << "OK\n";
+        if (!response.value("message", "").empty()) {
+            std::cout << response.at("message").get<std::string>() << "\n";
+        }
+    } else {
+        std::cout << "ERROR: " << response.value("code", 0) << "\n" << response.value("message", "") << "\n";
+    }
+}
+
+void print_listing(const minidrive::Listing& listing) {
+    std::cout << "OK\n";
+    for (const auto& entry : listing.entries) {
+        if (entry.is_directory) {
+            std::cout << entry.name << "/\n";
+        } else {
+            std::cout << entry.name << "  " << entry.size << "\n";
+        }
+    }
+}
+
+// Error reported by the server, as opposed to a broken connection.
+struct RemoteError : std::runtime_error {
+    RemoteError(int code, const std::string& message) : std::runtime_error(message), code(code) {}
+    int code;
+};
+
+// Asks the server for a listing. A cached copy is sent back as "if_version"
+// so that an unchanged directory costs only a tiny reply. The cache is updated
+// before the connection is released: a command that changes the directory
+// can only run, and drop the listing, after that.
+minidrive::Listing fetch_listing(Session& session, minidrive::ListingCache* cache, const std::string& path, bool prefetch = false) {
+    ConnectionTurn turn(session, prefetch);
+    json command;
+    command["cmd"] = "LIST";
+    command["args"]["path"] = path;
+    std::optional<minidrive::Listing> cached;
+    if (cache != nullptr) {
+        cached = cache->get(path);
+    }
+    if (cached) {
+        command["args"]["if_version"] = cached->version;
+    }
+
+    auto response = exchange(session, command, prefetch);
+    if (response.value("status", "") != "success") {
+        throw RemoteError(response.value("code", 0), response.value("message", "LIST failed"));
+    }
+    const auto& data = response.at("data");
+    if (cached && data.value("not_modified", false)) {
+        cache->revalidated(path);
+        cached->validated = std::chrono::steady_clock::now();
+        return *cached;
+    }
+
+    minidrive::Listing listing;
+    listing.validated = std::chrono::steady_clock::now();
+    listing.version = data.at("version").get<std::uint64_t>();
+    for (const auto& entry : data.at("entries")) {
+        listing.entries.push_back({entry.at("name").get<std::string>(), entry.at("type") == "dir", entry.at("size").get<std::uint64_t>()});
+    }
+    if (cache != nullptr) {
+        cache->put(path, listing);
+    }
+    return listing;
+}
+
+// Warms the listing cache in the background while the user reads a listing,
+// so that the next CD or LIST into a child directory needs no round trip.
+// Also revalidates stale listings the shell has just served from the cache.
+class Prefetcher {
+public:
+    Prefetcher(Session& session, minidrive::ListingCache& cache)
+        : session_(session), cache_(cache), worker_([this]() { run(); }) {}
+
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+    }
+
+    // Replaces queued work with the child directories of a listing the user just saw.
+    void prefetch_children(const std::string& directory, const minidrive::Listing& listing) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        enqueue_children(directory, listing);
+        wake_.notify_one();
+    }
+
+    // Fetches (or revalidates, if stale) one directory ahead of the rest of
+    // the queue; with `expand` its children follow once its listing arrives.
+    void prefetch(const std::string& directory, bool expand) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_front({directory, expand});
+        wake_.notify_one();
+    }
+
+private:
+    static constexpr std::size_t max_children = 32;
+
+    struct Job {
+        std::string path;
+        bool expand = false;
+    };
+
+    void enqueue_children(const std::string& directory, const minidrive::Listing& listing) {
+        std::size_t queued = 0;
+        for (const auto& entry : listing.entries) {
+            if (entry.is_directory && queued++ < max_children) {
+                queue_.push_back({minidrive::remote_child(directory, entry.name), false});
+            }
+        }
+    }
+
+    void run() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            try {
+                auto cached = cache_.get(job.path);
+                auto listing = cached && cache_.is_fresh(*cached) ? *cached : fetch_listing(session_, &cache_, job.path, true);
+                if (job.expand) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    enqueue_children(job.path, listing);
+                }
+            } catch (const RemoteError& e) {
+                // Gone or no longer accessible: stop completing from the old listing
+                cache_.invalidate(job.path);
+                log_debug("Prefetch of " + job.path + " failed: " + e.what());
+            } catch (const std::exception& e) {
+                log_debug("Prefetch of " + job.path + " failed: " + e.what());
+            }
+        }
+    }
+
+    Session& session_;
+    minidrive::ListingCache& cache_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> queue_;
+    bool stopping_ = false;
+    std::thread worker_;
+};
+
+void upload_file(Session& session, const std::string& local_path, const std::string& remote_path) {
+    // The upload is a multi-step exchange; keep the prefetcher off the connection meanwhile.
+    ConnectionTurn turn(session, false);
+    asio::ip::tcp::socket& socket = session.socket;
+    session.round_trips += 2;
     try {
         log_debug("Preparing to upload file: " + local_path + " as " + remote_path);
 
@@ -234,14 +478,235 @@ void upload_file(asio::ip::tcp::socket& socket, const std::string& local_path, c
     }
 }
 
-void interactive_shell(asio::ip::tcp::socket& socket) {
+// Terminal settings to restore if SIGINT arrives while the line is edited.
+termios saved_terminal{};
+
+void restore_terminal_and_reraise(int signal_number) {
+    ::tcsetattr(STDIN_FILENO, TCSANOW, &saved_terminal);
+    std::signal(signal_number, SIG_DFL);
+    std::raise(signal_number);
+}
+
+// Puts the terminal into raw mode for the lifetime of the object. The
+// original settings come back on every exit path, including Ctrl-C.
+class RawTerminal {
+public:
+    RawTerminal() {
+        ::tcgetattr(STDIN_FILENO, &saved_terminal);
+        previous_handler_ = std::signal(SIGINT, restore_terminal_and_reraise);
+        termios raw = saved_terminal;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+
+    ~RawTerminal() {
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &saved_terminal);
+        std::signal(SIGINT, previous_handler_);
+    }
+
+    RawTerminal(const RawTerminal&) = delete;
+    RawTerminal& operator=(const RawTerminal&) = delete;
+
+private:
+    void (*previous_handler_)(int) = SIG_DFL;
+};
+
+// Consumes the rest of an escape sequence after ESC: CSI ("ESC [ 3 ~") and
+// SS3 ("ESC O A") sequences run up to a final byte in 0x40-0x7E; any other
+// byte after ESC is a two-byte sequence. Returns false if input ends.
+bool skip_escape_sequence() {
+    char c = 0;
+    if (::read(STDIN_FILENO, &c, 1) != 1) {
+        return false;
+    }
+    if (c != '[' && c != 'O') {
+        return true;
+    }
+    bool csi = c == '[';
+    while (::read(STDIN_FILENO, &c, 1) == 1) {
+        // SS3 carries exactly one more byte; CSI parameters are 0x20-0x3F.
+        if (!csi || (c >= 0x40 && c <= 0x7E)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads a command line. On a terminal the line is edited in raw mode so that
+// Tab can complete the last word; scripts and pipes get a plain getline.
+bool read_command(std::string& line, const std::function<std::vector<std::string>(const std::string&)>& complete) {
+    line.clear();
+    if (!::isatty(STDIN_FILENO)) {
+        return static_cast<bool>(std::getline(std::cin, line));
+    }
+
+    RawTerminal terminal;
+    bool ok = true;
+    while (true) {
+        char c = 0;
+        if (::read(STDIN_FILENO, &c, 1) != 1 || (c == 4 && line.empty())) {
+            ok = false;
+            break;
+        }
+
+        if (c == '\n' || c == '\r') {
+            std::cout << "\n";
+            break;
+        } else if (c == 127 || c == '\b') {
+            if (!line.empty()) {
+                line.pop_back();
+                std::cout << "\b \b";
+            }
+        } else if (c == '\t') {
+            auto space = line.rfind(' ');
+            std::string word = space == std::string::npos ? line : line.substr(space + 1);
+            auto candidates = complete(line);
+            if (candidates.empty()) {
+                std::cout << '\a';
+            } else {
+                // Extend the word by whatever all candidates agree on
+                std::string common = candidates.front();
+                for (const auto& candidate : candidates) {
+                    auto mismatch = std::mismatch(common.begin(), common.end(), candidate.begin(), candidate.end());
+                    common.erase(mismatch.first, common.end());
+                }
+                if (common.size() > word.size()) {
+                    std::cout << common.substr(word.size());
+                    line += common.substr(word.size());
+                } else {
+                    std::cout << "\n";
+                    for (const auto& candidate : candidates) {
+                        std::cout << candidate << "  ";
+                    }
+                    std::cout << "\n> " << line;
+                }
+            }
+        } else if (c == 27) {
+            // Drop escape sequences such as arrow keys and Delete
+            if (!skip_escape_sequence()) {
+                ok = false;
+                break;
+            }
+        } else if (static_cast<unsigned char>(c) >= 32) {
+            line += c;
+            std::cout << c;
+        }
+        std::cout.flush();
+    }
+    return ok;
+}
+
+// Tab-completion candidates for the last word of `line`: command names first,
+// then remote paths taken from the listing cache without a round trip.
+std::vector<std::string> complete_word(const std::string& line, const std::string& cwd, minidrive::ListingCache* cache, Prefetcher* prefetcher) {
+    static const std::vector<std::string> commands = {
+        "LIST", "UPLOAD", "DOWNLOAD", "DELETE", "CD", "MKDIR", "RMDIR", "MOVE", "COPY", "HELP", "EXIT"};
+
+    std::vector<std::string> candidates;
+    auto space = line.rfind(' ');
+    if (space == std::string::npos) {
+        for (const auto& command : commands) {
+            if (command.rfind(line, 0) == 0) {
+                candidates.push_back(command + " ");
+            }
+        }
+        return candidates;
+    }
+
+    // UPLOAD's first argument is a local path
+    if (line.rfind("UPLOAD ", 0) == 0 && line.find_first_not_of(' ', 7) >= space) {
+        return candidates;
+    }
+    if (cache == nullptr) {
+        return candidates;
+    }
+
+    std::string word = line.substr(space + 1);
+    auto slash = word.rfind('/');
+    std::string directory_part = slash == std::string::npos ? "" : word.substr(0, slash + 1);
+    std::string prefix = word.substr(directory_part.size());
+
+    std::string directory;
+    try {
+        directory = minidrive::resolve_remote_path(cwd, directory_part.empty() ? "." : directory_part);
+    } catch (const std::invalid_argument&) {
+        return candidates;
+    }
+    if (!cache->get(directory)) {
+        // Nothing to offer yet; fetch it so that the next Tab has an answer
+        if (prefetcher != nullptr) {
+            prefetcher->prefetch(directory, false);
+        }
+        return candidates;
+    }
+
+    for (const auto& entry : cache->complete(directory, prefix)) {
+        candidates.push_back(directory_part + entry.name + (entry.is_directory ? "/" : ""));
+    }
+    return candidates;
+}
+
+// Serves a cached listing at once, however old, otherwise asks the server.
+// The caller queues a revalidation when the cached copy is stale.
+minidrive::Listing list_directory(Session& session, minidrive::ListingCache* cache, const std::string& path) {
+    if (cache != nullptr) {
+        if (auto cached = cache->get(path)) {
+            return *cached;
+        }
+    }
+    return fetch_listing(session, cache, path);
+}
+
+// Drops the listings of every directory above `path`. The server creates
+// missing intermediate directories, so more than the parent may have changed.
+void invalidate_ancestors(minidrive::ListingCache& cache, const std::string& path) {
+    for (auto directory = path; directory != "/";) {
+        directory = minidrive::remote_parent(directory);
+        cache.invalidate(directory);
+    }
+}
+
+// Drops cached listings that a successful remote command has made stale.
+void invalidate_listings(minidrive::ListingCache& cache, const json& command) {
+    std::string cmd = command.at("cmd").get<std::string>();
+    const auto& args = command.at("args");
+    if (cmd == "MKDIR" || cmd == "DELETE") {
+        invalidate_ancestors(cache, args.at("path").get<std::string>());
+    } else if (cmd == "RMDIR") {
+        cache.invalidate_tree(args.at("path").get<std::string>());
+        invalidate_ancestors(cache, args.at("path").get<std::string>());
+    } else if (cmd == "MOVE" || cmd == "COPY") {
+        if (cmd == "MOVE") {
+            cache.invalidate_tree(args.at("src").get<std::string>());
+            cache.invalidate(minidrive::remote_parent(args.at("src").get<std::string>()));
+        }
+        cache.invalidate_tree(args.at("dst").get<std::string>());
+        invalidate_ancestors(cache, args.at("dst").get<std::string>());
+    }
+}
+
+void interactive_shell(Session& session, minidrive::ListingCache* cache) {
     std::cout << "Enter commands. Type 'exit' to quit.\n";
 
+    std::optional<Prefetcher> prefetcher;
+    if (cache != nullptr) {
+        prefetcher.emplace(session, *cache);
+    }
+    std::string cwd = "/";
+    auto complete = [&](const std::string& line) {
+        return complete_word(line, cwd, cache, prefetcher ? &*prefetcher : nullptr);
+    };
+
     while (true) {
         try {
             std::string input;
-            std::cout << "> ";
-            std::getline(std::cin, input);
+            std::cout << "> " << std::flush;
+            if (!read_command(input, complete)) {
+                std::cout << "Exiting interactive shell.\n";
+                break;
+            }
 
             if (input == "exit" || input == "EXIT") {
                 std::cout << "Exiting interactive shell.\n";
@@ -270,25 +735,65 @@ void interactive_shell(asio::ip::tcp::socket& socket) {
                     if (remote_path.empty()) {
                         remote_path = local_path; // Default to the same name on the server
                     }
+                    remote_path = minidrive::resolve_remote_path(cwd, remote_path);
 
-                    upload_file(socket, local_path, remote_path);
-                } else {
-                    // Create JSON command for other commands
-                    std::string json_command = create_json_command(input);
+                    upload_file(session, local_path, remote_path);
+                    if (cache != nullptr) {
+                        invalidate_ancestors(*cache, remote_path);
+                    }
+                } else if (command == "LIST" || command == "CD") {
+                    std::string path;
+                    iss >> path;
+                    std::string target = minidrive::resolve_remote_path(cwd, path.empty() ? "." : path);
+
+                    // A directory seen in its parent's cached listing is entered at
+                    // once; its own listing is fetched in the background.
+                    if (command == "CD" && cache != nullptr && !cache->get(target)) {
+                        auto entry = cache->stat(target);
+                        if (entry && entry->is_directory) {
+                            cwd = target;
+                            std::cout << "OK\n";
+                            prefetcher->prefetch(target, true);
+                            continue;
+                        }
+                    }
 
-                    // Send the JSON command to the server
-                    asio::write(socket, asio::buffer(json_command + "\n"));
-                    std::cout << "Command sent to server: " << json_command << "\n";
+                    auto listing = list_directory(session, cache, target);
+                    if (command == "LIST") {
+                        print_listing(listing);
+                    } else {
+                        cwd = target;
+                        std::cout << "OK\n";
+                    }
+                    if (prefetcher) {
+                        prefetcher->prefetch_children(target, listing);
+                        if (!cache->is_fresh(listing)) {
+                            prefetcher->prefetch(target, false);
+                        }
+                    }
+                } else {
+                    auto json_command = json::parse(create_json_command(input, cwd));
+                    auto response = send_request(session, json_command);
+                    print_response(response);
+                    if (cache != nullptr && response.value("status", "") == "success") {
+                        invalidate_listings(*cache, json_command);
+                    }
                 }
             } else {
                 std::cout << "Invalid command or missing arguments.\n";
                 print_available_commands();
             }
+        } catch (const RemoteError& e) {
+            std::cout << "ERROR: " << e.code << "\n" << e.what() << "\n";
+        } catch (const std::invalid_argument& e) {
+            std::cout << "ERROR: 0\n" << e.what() << "\n";
         } catch (const std::exception& e) {
             std::cerr << "Error: " << e.what() << "\n";
             break;
         }
     }
+
+    log_debug("Round trips: " + std::to_string(session.round_trips) + " (prefetch: " + std::to_string(session.prefetch_round_trips) + ")");
 }
 
 std::tuple<std::string, std::string, std::string> parse_client_arguments(const std::string& arg) {
@@ -305,7 +810,7 @@ std::tuple<std::string, std::string, std::string> parse_client_arguments(const s
     throw std::invalid_argument("Invalid argument format. Expected: username@<server_ip>:<port>");
 }
 
-void attempt_connection(const std::string& arg) {
+void attempt_connection(const std::string& arg, bool use_cache) {
     try {
         auto [username, ip, port] = parse_client_arguments(arg);
 
@@ -322,7 +827,12 @@ void attempt_connection(const std::string& arg) {
         std::cout << "Successfully connected to " << ip << ":" << port << " as user " << username << "\n";
 
         // Start the interactive shell
-        interactive_shell(socket);
+        Session session(socket);
+        std::optional<minidrive::ListingCache> cache;
+        if (use_cache) {
+            cache.emplace(listing_max_age);
+        }
+        interactive_shell(session, cache ? &*cache : nullptr);
     } catch (const std::exception& e) {
         std::cerr << "Failed to connect: " << e.what() << "\n";
     }
@@ -332,12 +842,12 @@ void attempt_connection(const std::string& arg) {
 
 int main(int argc, char* argv[]) {
     try {
-        if (argc != 2) {
-            throw std::invalid_argument("Usage: ./client username@<server_ip>:<port>");
+        if (argc != 2 && (argc != 3 || std::string(argv[2]) != "--no-cache")) {
+            throw std::invalid_argument("Usage: ./client username@<server_ip>:<port> [--no-cache]");
         }
 
         std::string arg = argv[1];
-        attempt_connection(arg);
+        attempt_connection(arg, argc == 2);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
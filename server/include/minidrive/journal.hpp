@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace minidrive {
+
+// How journal records reach stable storage.
+enum class SyncMode {
+    group,         // concurrent commits share a single fdatasync
+    per_operation  // every commit pays for its own fdatasync
+};
+
+struct IndexEntry {
+    bool is_directory = false;
+    std::uint64_t size = 0;
+    // Journal sequence number of the last change. A directory also counts
+    // changes to its direct children, so this doubles as its listing version.
+    std::uint64_t seq = 0;
+};
+
+struct DirectoryListing {
+    std::uint64_t version = 0;
+    std::vector<std::pair<std::string, IndexEntry>> entries; // names, not paths
+};
+
+struct RecoveryStats {
+    std::size_t checkpoint_entries = 0;
+    std::size_t replayed_records = 0;
+    std::size_t redone_operations = 0;
+    std::size_t skipped_operations = 0; // unfinished but impossible to redo
+    bool scanned_tree = false;
+};
+
+// Append-only write-ahead journal of metadata mutations, kept in <root>/.minidrive.
+//
+// Each mutation is logged and made durable before it touches the filesystem.
+// Once the change is on disk (parent directories synced) it is applied to the
+// in-memory index and a "done" marker is queued; a failed change is cancelled
+// with an "abort" marker instead. Markers are flushed lazily with later records.
+// Commits on overlapping paths run one at a time.
+//
+// recover() loads the last checkpoint, replays the journal (applying every
+// operation that has a done marker) and redoes operations that have neither
+// marker. Without a checkpoint the tree is scanned first.
+//
+// Every checkpoint_interval records the journal is moved aside to
+// journal.old, a checkpoint is written from a copy of the index, and the old
+// segment is deleted. Operations still in flight are copied to the new segment.
+// Taking the copy holds the lock, so commits and lookups pause for it (roughly
+// 0.3 s per million entries); writing the file does not.
+//
+// Journal file: one JSON record per line, e.g.
+//   {"op":"upload","path":"alice/a.txt","seq":7,"size":12,"staged":"3.part"}
+//   {"op":"done","ref":7,"seq":8}
+// Checkpoint file: "minidrive-index 2 <last_seq> <count>" followed by
+// one "<d|f> <size> <seq> <path>" line per entry, with '\' and newlines in
+// the path escaped as "\\" and "\n" (format 1 wrote paths unescaped).
+class Journal {
+public:
+    explicit Journal(const std::filesystem::path& root, SyncMode mode = SyncMode::group,
+                     std::size_t checkpoint_interval = 100000);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Must be called once before any commit.
+    RecoveryStats recover();
+
+    // Each commit returns once its record is durable and the change has been
+    // applied on disk. Paths are relative to the root, '/'-separated. Invalid
+    // requests and failed filesystem changes throw; the index is left as is.
+    // The staged file must come from staging_path().
+    void commit_upload(const std::filesystem::path& staged, const std::string& path, std::uint64_t size);
+    void commit_mkdir(const std::string& path);
+    void commit_delete(const std::string& path);
+    void commit_move(const std::string& src, const std::string& dst);
+
+    // Writes the index to a new checkpoint and drops the journal it covers.
+    // Records whose filesystem change is still in flight are carried over.
+    void checkpoint();
+
+    // Fresh path in the staging directory for an upload in progress.
+    std::filesystem::path staging_path();
+
+    std::optional<IndexEntry> lookup(const std::string& path) const;
+    // Direct children of a directory, or nullopt if it is not one.
+    std::optional<DirectoryListing> list(const std::string& path) const;
+    std::size_t size() const;
+    // Every fsync issued for commits, recovery and checkpoints: journal,
+    // staged files and directories.
+    std::uint64_t fsync_count() const;
+    // Only the journal's own fdatasyncs, the ones group commit shares.
+    std::uint64_t journal_sync_count() const;
+
+private:
+    void commit(nlohmann::json record, const std::vector<std::string>& paths,
+                const std::function<void()>& validate, const std::function<void()>& perform);
+    bool overlaps_busy(const std::vector<std::string>& paths) const;
+    void release(const std::vector<std::string>& paths);
+    void enqueue(const nlohmann::json& record);
+    void wait_durable(std::unique_lock<std::mutex>& lock, std::uint64_t seq);
+    void drain(std::unique_lock<std::mutex>& lock);
+    void flush_locked(std::unique_lock<std::mutex>& lock);
+    void rotate();
+    void sync(const std::filesystem::path& path);
+
+    void apply(const nlohmann::json& record, std::uint64_t seq);
+    void touch_parent(const std::string& path, std::uint64_t seq);
+    bool redo(const nlohmann::json& record);
+
+    std::uint64_t load_checkpoint();
+    std::uint64_t scan_tree();
+    std::size_t replay(const std::filesystem::path& path, std::uint64_t checkpoint_seq,
+                       std::map<std::uint64_t, nlohmann::json>& unfinished);
+
+    std::filesystem::path root_;
+    std::filesystem::path dir_;
+    std::filesystem::path journal_path_;
+    std::filesystem::path previous_journal_path_;
+    std::filesystem::path checkpoint_path_;
+    std::filesystem::path staging_dir_;
+    SyncMode mode_;
+    std::size_t checkpoint_interval_;
+    int fd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_;
+    std::string pending_;
+    std::uint64_t next_seq_ = 1;
+    std::uint64_t durable_seq_ = 0;
+    bool flushing_ = false;
+    bool failed_ = false; // a journal write failed; no further commits are accepted
+    bool checkpointing_ = false;
+    std::size_t since_checkpoint_ = 0;
+    std::vector<std::string> busy_;
+    std::condition_variable released_;
+    std::atomic<std::uint64_t> fsyncs_{0};
+    std::atomic<std::uint64_t> journal_syncs_{0};
+    std::uint64_t staged_ = 0;
+    std::map<std::uint64_t, nlohmann::json> in_flight_;
+
+    std::map<std::string, IndexEntry> index_;
+};
+
+// Flushes a file's contents to stable storage.
+void sync_file(const std::filesystem::path& path);
+
+// Flushes a directory so that entries created or renamed in it are durable.
+void sync_directory(const std::filesystem::path& path);
+
+} // namespace minidrive
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include "minidrive/journal.hpp"
+
+namespace minidrive {
+
+// The "data" of a LIST reply. If the request's "if_version" matches the
+// directory's version, only the version and "not_modified" are sent back.
+nlohmann::json listing_data(const DirectoryListing& listing, const nlohmann::json& args);
+
+} // namespace minidrive
@@ -0,0 +1,808 @@
+#include "minidrive/journal.hpp"
+
+#include <cerrno>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace minidrive {
+
+namespace {
+
+[[noreturn]] void throw_errno(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void data_sync(int fd) {
+#ifdef __APPLE__
+    if (::fsync(fd) != 0) {
+#else
+    if (::fdatasync(fd) != 0) {
+#endif
+        throw_errno("Failed to sync journal");
+    }
+}
+
+void write_all(int fd, const std::string& data) {
+    const char* cursor = data.data();
+    std::size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, cursor, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("Failed to write journal");
+        }
+        cursor += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+}
+
+// Keys below `path` in the index are exactly those starting with "path/";
+// '0' is the character right after '/', so it bounds that range.
+std::map<std::string, IndexEntry>::iterator subtree_begin(std::map<std::string, IndexEntry>& index, const std::string& path) {
+    return index.lower_bound(path + "/");
+}
+
+std::map<std::string, IndexEntry>::iterator subtree_end(std::map<std::string, IndexEntry>& index, const std::string& path) {
+    return index.lower_bound(path + "0");
+}
+
+std::uint64_t parse_number(std::string_view text) {
+    std::uint64_t value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) {
+        throw std::runtime_error("Malformed number in checkpoint: " + std::string(text));
+    }
+    return value;
+}
+
+// Checkpoint lines end at '\n', so paths escape it (and the escape character).
+std::string escape_path(const std::string& path) {
+    std::string escaped;
+    escaped.reserve(path.size());
+    for (char c : path) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string unescape_path(std::string_view text) {
+    std::string path;
+    path.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\') {
+            path += text[i];
+        } else if (i + 1 < text.size() && (text[i + 1] == '\\' || text[i + 1] == 'n')) {
+            path += text[++i] == 'n' ? '\n' : '\\';
+        } else {
+            throw std::runtime_error("Malformed path in checkpoint: " + std::string(text));
+        }
+    }
+    return path;
+}
+
+} // namespace
+
+void sync_file(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw_errno("Failed to open " + path.string());
+    }
+    int result = ::fsync(fd);
+    int saved_errno = errno;
+    ::close(fd);
+    if (result != 0) {
+        errno = saved_errno;
+        throw_errno("Failed to sync " + path.string());
+    }
+}
+
+void sync_directory(const std::filesystem::path& path) {
+    sync_file(path);
+}
+
+Journal::Journal(const std::filesystem::path& root, SyncMode mode, std::size_t checkpoint_interval)
+    : root_(root),
+      dir_(root / ".minidrive"),
+      journal_path_(dir_ / "journal.log"),
+      previous_journal_path_(dir_ / "journal.old"),
+      checkpoint_path_(dir_ / "index.checkpoint"),
+      staging_dir_(dir_ / "staging"),
+      mode_(mode),
+      checkpoint_interval_(checkpoint_interval) {}
+
+Journal::~Journal() {
+    if (fd_ < 0) {
+        return;
+    }
+    try {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drain(lock);
+    } catch (const std::exception&) {
+        // Done markers are advisory; recovery redoes anything they would have covered.
+    }
+    ::close(fd_);
+}
+
+RecoveryStats Journal::recover() {
+    std::filesystem::create_directories(staging_dir_);
+
+    // The checkpoint alone decides whether the index can be trusted: a journal
+    // without one may predate the first checkpoint and say nothing about the
+    // files that were already there. A scan already reflects every completed
+    // operation, so the journal then only contributes the unfinished ones.
+    RecoveryStats stats;
+    std::uint64_t checkpoint_seq = 0;
+    std::uint64_t last_used_seq = 0;
+    if (std::filesystem::exists(checkpoint_path_)) {
+        checkpoint_seq = load_checkpoint();
+        last_used_seq = checkpoint_seq;
+        stats.checkpoint_entries = index_.size();
+    } else {
+        last_used_seq = scan_tree();
+        checkpoint_seq = std::numeric_limits<std::uint64_t>::max();
+        stats.scanned_tree = true;
+    }
+
+    bool had_previous = std::filesystem::exists(previous_journal_path_);
+    std::map<std::uint64_t, json> unfinished;
+    next_seq_ = last_used_seq + 1;
+    stats.replayed_records = replay(previous_journal_path_, checkpoint_seq, unfinished);
+    stats.replayed_records += replay(journal_path_, checkpoint_seq, unfinished);
+    for (const auto& [seq, record] : unfinished) {
+        try {
+            if (redo(record)) {
+                // A fresh number keeps listing versions from going backwards after a scan.
+                apply(record, next_seq_++);
+                ++stats.redone_operations;
+                continue;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Journal: cannot redo record " << seq << ": " << e.what() << "\n";
+        }
+        ++stats.skipped_operations;
+    }
+
+    // Whatever is left in staging never made it into the journal.
+    for (const auto& entry : std::filesystem::directory_iterator(staging_dir_)) {
+        std::filesystem::remove_all(entry.path());
+    }
+
+    fd_ = ::open(journal_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw_errno("Failed to open journal " + journal_path_.string());
+    }
+    sync(dir_);
+    durable_seq_ = next_seq_ - 1;
+
+    if (stats.scanned_tree || had_previous || stats.replayed_records > 0 || !unfinished.empty()) {
+        checkpoint();
+    }
+    return stats;
+}
+
+void Journal::commit_upload(const std::filesystem::path& staged, const std::string& path, std::uint64_t size) {
+    auto target = root_ / path;
+
+    // The data must be durable before the record that publishes it.
+    sync(staged);
+    sync(staging_dir_);
+
+    commit({{"op", "upload"}, {"path", path}, {"staged", staged.filename().string()}, {"size", size}}, {path},
+        [&]() {
+            if (!std::filesystem::is_directory(target.parent_path())) {
+                throw std::runtime_error("Parent directory does not exist: " + path);
+            }
+            if (std::filesystem::is_directory(target)) {
+                throw std::runtime_error("Target is a directory: " + path);
+            }
+        },
+        [&]() {
+            std::filesystem::rename(staged, target);
+            sync(target.parent_path());
+        });
+}
+
+void Journal::commit_mkdir(const std::string& path) {
+    auto target = root_ / path;
+    commit({{"op", "mkdir"}, {"path", path}}, {path},
+        [&]() {
+            if (std::filesystem::exists(target)) {
+                throw std::runtime_error("Path already exists: " + path);
+            }
+        },
+        [&]() {
+            // Every directory created on the way needs its parent synced.
+            std::vector<std::filesystem::path> created;
+            for (auto level = target; !std::filesystem::exists(level); level = level.parent_path()) {
+                created.push_back(level);
+            }
+            std::filesystem::create_directories(target);
+            for (const auto& level : created) {
+                sync(level.parent_path());
+            }
+        });
+}
+
+void Journal::commit_delete(const std::string& path) {
+    auto target = root_ / path;
+    commit({{"op", "delete"}, {"path", path}}, {path},
+        [&]() {
+            if (!std::filesystem::exists(target)) {
+                throw std::runtime_error("Path does not exist: " + path);
+            }
+        },
+        [&]() {
+            std::filesystem::remove_all(target);
+            sync(target.parent_path());
+        });
+}
+
+void Journal::commit_move(const std::string& src, const std::string& dst) {
+    auto source = root_ / src;
+    auto target = root_ / dst;
+    commit({{"op", "move"}, {"src", src}, {"dst", dst}}, {src, dst},
+        [&]() {
+            if (dst == src || dst.rfind(src + "/", 0) == 0) {
+                throw std::runtime_error("Cannot move a directory into itself: " + src);
+            }
+            if (!std::filesystem::exists(source)) {
+                throw std::runtime_error("Path does not exist: " + src);
+            }
+            if (std::filesystem::exists(target)) {
+                throw std::runtime_error("Path already exists: " + dst);
+            }
+            if (!std::filesystem::is_directory(target.parent_path())) {
+                throw std::runtime_error("Parent directory does not exist: " + dst);
+            }
+        },
+        [&]() {
+            std::filesystem::rename(source, target);
+            sync(source.parent_path());
+            if (target.parent_path() != source.parent_path()) {
+                sync(target.parent_path());
+            }
+        });
+}
+
+// Checks and logs an operation under the lock, so no other commit on an
+// overlapping path can slip in between; then performs it outside the lock.
+// The index only learns about changes that actually reached the disk.
+void Journal::commit(json record, const std::vector<std::string>& paths,
+                     const std::function<void()>& validate, const std::function<void()>& perform) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [&]() { return !overlaps_busy(paths); });
+    if (failed_) {
+        throw std::runtime_error("Journal is unavailable after a failed write");
+    }
+    validate();
+
+    busy_.insert(busy_.end(), paths.begin(), paths.end());
+    auto seq = next_seq_++;
+    record["seq"] = seq;
+    enqueue(record);
+    in_flight_.emplace(seq, record);
+    try {
+        wait_durable(lock, seq);
+    } catch (...) {
+        in_flight_.erase(seq);
+        release(paths);
+        throw;
+    }
+    lock.unlock();
+
+    try {
+        perform();
+    } catch (...) {
+        // The record is durable but the change did not happen; cancel it so
+        // that recovery does not try again.
+        lock.lock();
+        in_flight_.erase(seq);
+        enqueue({{"op", "abort"}, {"ref", seq}, {"seq", next_seq_++}});
+        release(paths);
+        throw;
+    }
+
+    lock.lock();
+    in_flight_.erase(seq);
+    apply(record, seq);
+    enqueue({{"op", "done"}, {"ref", seq}, {"seq", next_seq_++}});
+    release(paths);
+    bool due = since_checkpoint_ >= checkpoint_interval_ && !checkpointing_;
+    lock.unlock();
+
+    if (due) {
+        try {
+            checkpoint();
+        } catch (const std::exception& e) {
+            // The journal still holds everything; the next attempt folds it in.
+            std::cerr << "Journal: checkpoint failed: " << e.what() << "\n";
+        }
+    }
+}
+
+bool Journal::overlaps_busy(const std::vector<std::string>& paths) const {
+    for (const auto& path : paths) {
+        for (const auto& busy : busy_) {
+            if (path == busy || path.rfind(busy + "/", 0) == 0 || busy.rfind(path + "/", 0) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Journal::release(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) {
+        busy_.erase(std::find(busy_.begin(), busy_.end(), path));
+    }
+    released_.notify_all();
+}
+
+void Journal::enqueue(const json& record) {
+    pending_ += record.dump();
+    pending_ += '\n';
+    ++since_checkpoint_;
+}
+
+void Journal::checkpoint() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (checkpointing_) {
+        return;
+    }
+    checkpointing_ = true;
+
+    // A flat copy is about half the cost of copying the map, and this part
+    // holds the lock.
+    std::vector<std::pair<std::string, IndexEntry>> index;
+    std::uint64_t last_seq = 0;
+    try {
+        drain(lock);
+        rotate();
+        last_seq = next_seq_ - 1;
+        index.assign(index_.begin(), index_.end());
+    } catch (...) {
+        checkpointing_ = false;
+        throw;
+    }
+    lock.unlock();
+
+    // The snapshot is written without the lock; commits carry on into the new segment.
+    try {
+        auto temporary = checkpoint_path_;
+        temporary += ".tmp";
+        {
+            std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+            if (!output.is_open()) {
+                throw std::runtime_error("Failed to open checkpoint for writing: " + temporary.string());
+            }
+            output << "minidrive-index 2 " << last_seq << ' ' << index.size() << '\n';
+            for (const auto& [path, entry] : index) {
+                output << (entry.is_directory ? 'd' : 'f') << ' ' << entry.size << ' ' << entry.seq << ' '
+                       << escape_path(path) << '\n';
+            }
+            output.close();
+            if (!output) {
+                throw std::runtime_error("Failed to write checkpoint: " + temporary.string());
+            }
+        }
+        sync(temporary);
+        std::filesystem::rename(temporary, checkpoint_path_);
+        sync(dir_);
+
+        std::filesystem::remove(previous_journal_path_);
+        sync(dir_);
+    } catch (...) {
+        lock.lock();
+        checkpointing_ = false;
+        throw;
+    }
+
+    lock.lock();
+    checkpointing_ = false;
+}
+
+// Moves everything logged so far into journal.old and starts an empty segment
+// holding only the records still in flight. Called with the lock held and
+// nothing pending. If journal.old is left over from a failed checkpoint, the
+// current segment is appended to it instead.
+void Journal::rotate() {
+    if (std::filesystem::exists(previous_journal_path_)) {
+        std::ifstream current(journal_path_, std::ios::binary);
+        std::ofstream previous(previous_journal_path_, std::ios::binary | std::ios::app);
+        previous << current.rdbuf();
+        previous.close();
+        if (!previous) {
+            throw std::runtime_error("Failed to extend " + previous_journal_path_.string());
+        }
+        sync(previous_journal_path_);
+        if (::ftruncate(fd_, 0) != 0) {
+            throw_errno("Failed to truncate journal");
+        }
+    } else {
+        std::filesystem::rename(journal_path_, previous_journal_path_);
+        int fd = ::open(journal_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw_errno("Failed to open journal " + journal_path_.string());
+        }
+        ::close(fd_);
+        fd_ = fd;
+        sync(dir_);
+    }
+
+    std::string carried;
+    for (const auto& [seq, record] : in_flight_) {
+        carried += record.dump();
+        carried += '\n';
+    }
+    write_all(fd_, carried);
+    data_sync(fd_);
+    ++fsyncs_;
+    ++journal_syncs_;
+    since_checkpoint_ = in_flight_.size();
+}
+
+std::filesystem::path Journal::staging_path() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return staging_dir_ / (std::to_string(++staged_) + ".part");
+}
+
+std::optional<IndexEntry> Journal::lookup(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(path);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<DirectoryListing> Journal::list(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto dir = index_.find(path);
+    if (dir == index_.end() || !dir->second.is_directory) {
+        return std::nullopt;
+    }
+
+    DirectoryListing listing;
+    listing.version = dir->second.seq;
+    auto prefix = path + "/";
+    auto last = index_.lower_bound(path + "0");
+    for (auto it = index_.lower_bound(prefix); it != last;) {
+        auto name = it->first.substr(prefix.size());
+        if (name.find('/') != std::string::npos) {
+            ++it;
+            continue;
+        }
+        listing.entries.emplace_back(name, it->second);
+        // Skip the child's own subtree rather than walking every descendant.
+        it = index_.lower_bound(it->first + "0");
+    }
+    return listing;
+}
+
+std::size_t Journal::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+std::uint64_t Journal::fsync_count() const {
+    return fsyncs_;
+}
+
+std::uint64_t Journal::journal_sync_count() const {
+    return journal_syncs_;
+}
+
+void Journal::sync(const std::filesystem::path& path) {
+    sync_file(path);
+    ++fsyncs_;
+}
+
+void Journal::wait_durable(std::unique_lock<std::mutex>& lock, std::uint64_t seq) {
+    while (durable_seq_ < seq) {
+        if (failed_) {
+            throw std::runtime_error("Journal write failed; the record is not durable");
+        }
+        if (flushing_) {
+            flushed_.wait(lock);
+        } else {
+            flush_locked(lock);
+        }
+    }
+}
+
+// Waits until everything queued so far is durable.
+void Journal::drain(std::unique_lock<std::mutex>& lock) {
+    while (flushing_ || !pending_.empty()) {
+        if (failed_) {
+            throw std::runtime_error("Journal write failed; the record is not durable");
+        }
+        if (flushing_) {
+            flushed_.wait(lock);
+        } else {
+            flush_locked(lock);
+        }
+    }
+}
+
+// Writes out everything pending as one batch. In group mode the lock is
+// released during the write so that other commits can queue up behind it and
+// ride along on the next fdatasync.
+//
+// A failed write or fdatasync is final: after an fsync error the kernel may
+// have dropped the dirty pages, so retrying on the same descriptor could
+// report success for data that never reached the disk. Every waiter fails.
+void Journal::flush_locked(std::unique_lock<std::mutex>& lock) {
+    flushing_ = true;
+    std::string batch;
+    batch.swap(pending_);
+    auto batch_seq = next_seq_ - 1;
+
+    if (mode_ == SyncMode::group) {
+        lock.unlock();
+    }
+    std::exception_ptr error;
+    try {
+        write_all(fd_, batch);
+        data_sync(fd_);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (mode_ == SyncMode::group) {
+        lock.lock();
+    }
+
+    flushing_ = false;
+    if (error) {
+        failed_ = true;
+    } else {
+        ++fsyncs_;
+        ++journal_syncs_;
+        durable_seq_ = batch_seq;
+    }
+    flushed_.notify_all();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Journal::apply(const json& record, std::uint64_t seq) {
+    const auto& op = record.at("op").get_ref<const std::string&>();
+    if (op == "upload") {
+        auto path = record.at("path").get<std::string>();
+        index_[path] = {false, record.at("size").get<std::uint64_t>(), seq};
+        touch_parent(path, seq);
+    } else if (op == "mkdir") {
+        // Mirrors create_directories: missing parents come into existence too.
+        std::filesystem::path path = record.at("path").get<std::string>();
+        for (; !path.empty(); path = path.parent_path()) {
+            auto [it, inserted] = index_.try_emplace(path.generic_string(), IndexEntry{true, 0, seq});
+            if (!inserted) {
+                break;
+            }
+            touch_parent(it->first, seq);
+        }
+    } else if (op == "delete") {
+        auto path = record.at("path").get<std::string>();
+        index_.erase(subtree_begin(index_, path), subtree_end(index_, path));
+        index_.erase(path);
+        touch_parent(path, seq);
+    } else if (op == "move") {
+        auto src = record.at("src").get<std::string>();
+        auto dst = record.at("dst").get<std::string>();
+        auto node = index_.extract(src);
+        if (node.empty()) {
+            return;
+        }
+        auto first = subtree_begin(index_, src);
+        auto last = subtree_end(index_, src);
+        // Everything below gets a new version too: a directory that reappears
+        // at a path must not repeat a version seen there before.
+        std::map<std::string, IndexEntry> moved;
+        for (auto it = first; it != last; ++it) {
+            moved.emplace(dst + it->first.substr(src.size()), IndexEntry{it->second.is_directory, it->second.size, seq});
+        }
+        index_.erase(first, last);
+        node.key() = dst;
+        node.mapped().seq = seq;
+        // rename() replaces an existing destination, and so does the index.
+        index_.erase(subtree_begin(index_, dst), subtree_end(index_, dst));
+        index_.erase(dst);
+        index_.insert(std::move(node));
+        index_.merge(moved);
+        touch_parent(src, seq);
+        touch_parent(dst, seq);
+    }
+}
+
+void Journal::touch_parent(const std::string& path, std::uint64_t seq) {
+    auto slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return;
+    }
+    auto parent = index_.find(path.substr(0, slash));
+    if (parent != index_.end()) {
+        parent->second.seq = seq;
+    }
+}
+
+// Re-applies a logged operation that has neither a done nor an abort marker.
+// Each branch checks the disk first because the change may already be there.
+// Returns whether the change is now on disk; throws if it cannot be made.
+bool Journal::redo(const json& record) {
+    const auto& op = record.at("op").get_ref<const std::string&>();
+    if (op == "upload") {
+        auto staged = staging_dir_ / record.at("staged").get<std::string>();
+        auto target = root_ / record.at("path").get<std::string>();
+        if (!std::filesystem::exists(staged)) {
+            return std::filesystem::exists(target);
+        }
+        std::filesystem::rename(staged, target);
+        sync(target.parent_path());
+        return true;
+    } else if (op == "mkdir") {
+        auto target = root_ / record.at("path").get<std::string>();
+        std::filesystem::create_directories(target);
+        sync(target.parent_path());
+        return true;
+    } else if (op == "delete") {
+        auto target = root_ / record.at("path").get<std::string>();
+        std::filesystem::remove_all(target);
+        sync(target.parent_path());
+        return true;
+    } else if (op == "move") {
+        auto src = root_ / record.at("src").get<std::string>();
+        auto dst = root_ / record.at("dst").get<std::string>();
+        if (!std::filesystem::exists(src)) {
+            return std::filesystem::exists(dst);
+        }
+        if (std::filesystem::exists(dst)) {
+            throw std::runtime_error("both " + src.string() + " and " + dst.string() + " exist");
+        }
+        std::filesystem::rename(src, dst);
+        sync(src.parent_path());
+        sync(dst.parent_path());
+        return true;
+    }
+    return false;
+}
+
+std::uint64_t Journal::load_checkpoint() {
+    std::ifstream input(checkpoint_path_, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Failed to open checkpoint: " + checkpoint_path_.string());
+    }
+
+    std::string line;
+    std::getline(input, line);
+    std::istringstream header(line);
+    std::string magic;
+    int format = 0;
+    std::uint64_t last_seq = 0;
+    std::size_t count = 0;
+    if (!(header >> magic >> format >> last_seq >> count) || magic != "minidrive-index" || (format != 1 && format != 2)) {
+        throw std::runtime_error("Unrecognised checkpoint header: " + line);
+    }
+
+    // "<d|f> <size> <seq> <path>"; the path is last so it may contain spaces.
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!std::getline(input, line) || line.size() < 7 || line[1] != ' ') {
+            throw std::runtime_error("Truncated checkpoint: " + checkpoint_path_.string());
+        }
+        auto size_end = line.find(' ', 2);
+        auto seq_end = size_end == std::string::npos ? std::string::npos : line.find(' ', size_end + 1);
+        if (seq_end == std::string::npos) {
+            throw std::runtime_error("Malformed checkpoint entry: " + line);
+        }
+        std::string_view view(line);
+        IndexEntry entry;
+        entry.is_directory = line[0] == 'd';
+        entry.size = parse_number(view.substr(2, size_end - 2));
+        entry.seq = parse_number(view.substr(size_end + 1, seq_end - size_end - 1));
+        auto path = view.substr(seq_end + 1);
+        index_.emplace_hint(index_.end(), format == 1 ? std::string(path) : unescape_path(path), entry);
+    }
+    return last_seq;
+}
+
+// Numbers the scanned entries from the wall clock in microseconds, so that
+// each directory gets a version of its own that is above anything handed out
+// before the index was lost. Returns the last number used.
+std::uint64_t Journal::scan_tree() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto seq = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    auto it = std::filesystem::recursive_directory_iterator(root_);
+    for (; it != std::filesystem::recursive_directory_iterator(); ++it) {
+        if (it->path() == dir_) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        IndexEntry entry;
+        entry.is_directory = it->is_directory();
+        if (!entry.is_directory) {
+            entry.size = it->file_size();
+        }
+        entry.seq = ++seq;
+        index_.emplace(it->path().lexically_relative(root_).generic_string(), entry);
+    }
+    return seq;
+}
+
+
+// Reads one journal segment. Operations are applied to the index when their
+// done marker appears (the order in which they completed) unless the marker
+// is already covered by the checkpoint; aborted ones are dropped, and the
+// rest are left in `unfinished`. A torn final record (a crash during a write
+// that was never acknowledged) is cut off.
+std::size_t Journal::replay(const std::filesystem::path& path, std::uint64_t checkpoint_seq,
+                            std::map<std::uint64_t, json>& unfinished) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        return 0;
+    }
+
+    std::uintmax_t good_bytes = 0;
+    bool torn = false;
+    std::size_t replayed = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (input.eof()) {
+            torn = true; // no trailing newline
+            break;
+        }
+        auto record = json::parse(line, nullptr, false);
+        if (record.is_discarded() || !record.contains("seq") || !record.contains("op")) {
+            torn = true;
+            break;
+        }
+        good_bytes += line.size() + 1;
+
+        auto seq = record.at("seq").get<std::uint64_t>();
+        const auto& op = record.at("op");
+        if (op == "done" || op == "abort") {
+            auto it = unfinished.find(record.at("ref").get<std::uint64_t>());
+            if (it != unfinished.end()) {
+                if (op == "done" && seq > checkpoint_seq) {
+                    apply(it->second, it->first);
+                }
+                unfinished.erase(it);
+            }
+        } else {
+            // A record carried over by a checkpoint may appear in both segments.
+            unfinished.emplace(seq, std::move(record));
+        }
+        if (seq > checkpoint_seq) {
+            ++replayed;
+        }
+        next_seq_ = std::max(next_seq_, seq + 1);
+    }
+    input.close();
+
+    if (torn) {
+        std::filesystem::resize_file(path, good_bytes);
+    }
+    return replayed;
+}
+
+} // namespace minidrive
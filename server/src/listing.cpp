@@ -0,0 +1,20 @@
+#include "minidrive/listing.hpp"
+
+namespace minidrive {
+
+nlohmann::json listing_data(const DirectoryListing& listing, const nlohmann::json& args) {
+    nlohmann::json data;
+    data["version"] = listing.version;
+    if (args.contains("if_version") && args.at("if_version").get<std::uint64_t>() == listing.version) {
+        data["not_modified"] = true;
+        return data;
+    }
+
+    data["entries"] = nlohmann::json::array();
+    for (const auto& [name, entry] : listing.entries) {
+        data["entries"].push_back({{"name", name}, {"type", entry.is_directory ? "dir" : "file"}, {"size", entry.size}});
+    }
+    return data;
+}
+
+} // namespace minidrive
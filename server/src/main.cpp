@@ -1,22 +1,26 @@
 #include <iostream>
 #include <asio.hpp>
 #include <string>
+#include <chrono>
 #include <signal.h>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 #include <nlohmann/json.hpp>
 
+#include "minidrive/journal.hpp"
+#include "minidrive/listing.hpp"
 #include "minidrive/version.hpp"
 
 using json = nlohmann::json;
 
-void handle_client(asio::ip::tcp::socket &socket, const std::string& root_path);
+void handle_client(asio::ip::tcp::socket &socket, const std::string& root_path, minidrive::Journal& journal);
 
-void create_user_directory(const std::string& root_path, const std::string& username) {
+void create_user_directory(const std::string& root_path, const std::string& username, minidrive::Journal& journal) {
     try {
         std::string user_folder = root_path + "/" + username;
         if (!std::filesystem::exists(user_folder)) {
-            std::filesystem::create_directories(user_folder);
+            journal.commit_mkdir(username);
             std::cout << "User directory created at: " << user_folder << "\n";
         } else {
             std::cout << "User directory already exists at: " << user_folder << "\n";
@@ -45,14 +49,36 @@ void log_debug(const std::string& message) {
     std::cout << "[DEBUG] " << message << "\n";
 }
 
-void handle_upload(const std::string& username, const std::string& root_path, asio::ip::tcp::socket& socket, const json& args) {
+// Maps a client path onto its root-relative journal key, e.g. "docs/../a.txt" -> "alice/a.txt".
+std::string resolve_user_path(const std::string& username, const std::string& path) {
+    if (path.find('\n') != std::string::npos) {
+        throw std::runtime_error("Invalid path: " + path);
+    }
+    std::filesystem::path relative = std::filesystem::path(path).relative_path();
+    std::string key = (std::filesystem::path(username) / relative).lexically_normal().generic_string();
+    while (!key.empty() && key.back() == '/') {
+        key.pop_back();
+    }
+    if (key != username && key.rfind(username + "/", 0) != 0) {
+        throw std::runtime_error("Path escapes user directory: " + path);
+    }
+    return key;
+}
+
+// `input` is the connection's read buffer: bytes the client sent after the
+// size line may already be waiting in it.
+void handle_upload(const std::string& username, const std::string& root_path, asio::ip::tcp::socket& socket, asio::streambuf& input, const json& args, minidrive::Journal& journal) {
+    std::filesystem::path staged_path;
     try {
         log_debug("Handling UPLOAD command");
 
         // Extract file paths from the arguments
         std::string filename = args.at("filename").get<std::string>();
-        std::string user_directory = root_path + "/" + username;
-        std::string file_path = user_directory + "/" + filename;
+        std::string file_key = resolve_user_path(username, filename);
+        std::string file_path = root_path + "/" + file_key;
+
+        // Data goes to the staging area first; the journal publishes it at its final path
+        staged_path = journal.staging_path();
 
         log_debug("Preparing to receive file: " + filename);
 
@@ -63,28 +89,34 @@ void handle_upload(const std::string& username, const std::string& root_path, as
         }
 
         // Open the file for writing
-        std::ofstream output_file(file_path, std::ios::binary);
+        std::ofstream output_file(staged_path, std::ios::binary);
         if (!output_file.is_open()) {
-            throw std::runtime_error("Failed to open file for writing: " + file_path);
+            throw std::runtime_error("Failed to open file for writing: " + staged_path.string());
         }
 
-        log_debug("File opened for writing: " + file_path);
+        log_debug("File opened for writing: " + staged_path.string());
 
         // Receive the file size
-        asio::streambuf buffer;
-        asio::read_until(socket, buffer, '\n');
-        std::istream input_stream(&buffer);
+        asio::read_until(socket, input, '\n');
+        std::istream input_stream(&input);
         std::string file_size_str;
         std::getline(input_stream, file_size_str);
         size_t file_size = std::stoull(file_size_str);
 
         log_debug("Expecting file size: " + std::to_string(file_size));
 
-        // Receive the file data
+        // Receive the file data, starting with whatever is already buffered
         size_t bytes_received = 0;
         while (bytes_received < file_size) {
             char data[1024];
-            size_t len = socket.read_some(asio::buffer(data, std::min(file_size - bytes_received, sizeof(data))));
+            size_t wanted = std::min(file_size - bytes_received, sizeof(data));
+            size_t len = 0;
+            if (input.size() > 0) {
+                len = asio::buffer_copy(asio::buffer(data, wanted), input.data());
+                input.consume(len);
+            } else {
+                len = socket.read_some(asio::buffer(data, wanted));
+            }
             output_file.write(data, len);
             bytes_received += len;
 
@@ -92,19 +124,65 @@ void handle_upload(const std::string& username, const std::string& root_path, as
         }
 
         output_file.close();
+        journal.commit_upload(staged_path, file_key, file_size);
         log_debug("File received and saved to: " + file_path);
 
         // Send acknowledgment to the client
         send_response(socket, "success", "File uploaded successfully.");
         log_debug("Acknowledgment sent to client.");
     } catch (const std::exception& e) {
+        if (!staged_path.empty()) {
+            std::error_code ignored;
+            std::filesystem::remove(staged_path, ignored);
+        }
         std::cerr << "Error handling upload: " << e.what() << "\n";
         send_response(socket, "error", e.what());
         log_debug("Error during upload: " + std::string(e.what()));
     }
 }
 
-void handle_command(const std::string& username, const std::string& root_path, asio::ip::tcp::socket& socket, const json& json_message) {
+// Answers from the journal index. Clients cache listings and send back the
+// version they hold as "if_version"; an unchanged directory gets a bare reply.
+void handle_list(const std::string& username, asio::ip::tcp::socket& socket, const json& args, minidrive::Journal& journal) {
+    std::string requested = args.value("path", ".");
+    auto listing = journal.list(resolve_user_path(username, requested));
+    if (!listing) {
+        throw std::runtime_error("Not a directory: " + requested);
+    }
+
+    auto data = minidrive::listing_data(*listing, args);
+    send_response(socket, "success", data.contains("not_modified") ? "Not modified." : "", 0, data);
+}
+
+void handle_mkdir(const std::string& username, asio::ip::tcp::socket& socket, const json& args, minidrive::Journal& journal) {
+    std::string path = resolve_user_path(username, args.at("path").get<std::string>());
+    journal.commit_mkdir(path);
+    send_response(socket, "success", "Directory created.");
+}
+
+void handle_delete(const std::string& username, const std::string& root_path, asio::ip::tcp::socket& socket, const json& args, bool directory, minidrive::Journal& journal) {
+    std::string path = resolve_user_path(username, args.at("path").get<std::string>());
+    if (path == username) {
+        throw std::runtime_error("Cannot remove the user directory.");
+    }
+    if (std::filesystem::is_directory(root_path + "/" + path) != directory) {
+        throw std::runtime_error(directory ? "Not a directory: " + path : "Not a file: " + path);
+    }
+    journal.commit_delete(path);
+    send_response(socket, "success", directory ? "Directory removed." : "File deleted.");
+}
+
+void handle_move(const std::string& username, asio::ip::tcp::socket& socket, const json& args, minidrive::Journal& journal) {
+    std::string src = resolve_user_path(username, args.at("src").get<std::string>());
+    std::string dst = resolve_user_path(username, args.at("dst").get<std::string>());
+    if (src == username || dst == username) {
+        throw std::runtime_error("Cannot move the user directory.");
+    }
+    journal.commit_move(src, dst);
+    send_response(socket, "success", "Moved.");
+}
+
+void handle_command(const std::string& username, const std::string& root_path, asio::ip::tcp::socket& socket, asio::streambuf& input, const json& json_message, minidrive::Journal& journal) {
     try {
         // Extract the command and arguments
         std::string command = json_message.at("cmd").get<std::string>();
@@ -114,7 +192,15 @@ void handle_command(const std::string& username, const std::string& root_path, a
         std::cout << "Arguments: " << args.dump() << "\n";
 
         if (command == "UPLOAD") {
-            handle_upload(username, root_path, socket, args);
+            handle_upload(username, root_path, socket, input, args, journal);
+        } else if (command == "LIST") {
+            handle_list(username, socket, args, journal);
+        } else if (command == "MKDIR") {
+            handle_mkdir(username, socket, args, journal);
+        } else if (command == "DELETE" || command == "RMDIR") {
+            handle_delete(username, root_path, socket, args, command == "RMDIR", journal);
+        } else if (command == "MOVE") {
+            handle_move(username, socket, args, journal);
         } else {
             // Placeholder for other commands
             send_response(socket, "success", "Command received: " + command);
@@ -128,12 +214,15 @@ void handle_command(const std::string& username, const std::string& root_path, a
     }
 }
 
-void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path) {
+void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path, minidrive::Journal& journal) {
     try {
         log_debug("New client connected: " + socket.remote_endpoint().address().to_string());
 
-        // Read the username from the client
+        // One buffer for the whole connection: read_until may read past the
+        // newline, and those bytes belong to the next message.
         asio::streambuf buffer;
+
+        // Read the username from the client
         asio::read_until(socket, buffer, '\n');
         std::istream input_stream(&buffer);
         std::string username;
@@ -144,10 +233,16 @@ void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path)
             return;
         }
 
+        // Names starting with '.' are reserved for server state such as the journal
+        if (username.front() == '.' || username.find('/') != std::string::npos) {
+            log_debug("Rejected username: " + username);
+            return;
+        }
+
         log_debug("Username received: " + username);
 
         // Create a directory for the user if it doesn't exist
-        create_user_directory(root_path, username);
+        create_user_directory(root_path, username, journal);
 
         // Send a welcome message to the client
         //send_response(socket, "success", "Welcome, " + username + "!");
@@ -155,7 +250,6 @@ void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path)
 
         while (true) {
             // Read a message from the client
-            asio::streambuf buffer;
             asio::read_until(socket, buffer, '\n');
 
             // Extract the message
@@ -175,7 +269,7 @@ void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path)
                 auto json_message = json::parse(message);
 
                 // Handle the command
-                handle_command(username, root_path, socket, json_message);
+                handle_command(username, root_path, socket, buffer, json_message, journal);
             } catch (const json::exception& e) {
                 std::cerr << "Invalid JSON received: " << e.what() << "\n";
                 send_response(socket, "error", "Invalid JSON format.");
@@ -188,7 +282,7 @@ void handle_client(asio::ip::tcp::socket& socket, const std::string& root_path)
     }
 }
 
-void run_server(const std::string& host, const std::string& port, std::string root_path) {
+void run_server(const std::string& host, const std::string& port, std::string root_path, minidrive::Journal& journal) {
     try {
         asio::io_context io_context;
 
@@ -201,8 +295,10 @@ void run_server(const std::string& host, const std::string& port, std::string ro
 
             std::cout << "New connection from " << socket.remote_endpoint() << "\n";
 
-            // Handle the client connection
-            handle_client(socket, root_path);
+            // Handle the client connection; concurrent commits share journal fsyncs
+            std::thread([socket = std::move(socket), root_path, &journal]() mutable {
+                handle_client(socket, root_path, journal);
+            }).detach();
         }
     } catch (const std::exception& e) {
         std::cerr << "Server error: " << e.what() << "\n";
@@ -268,9 +364,20 @@ int main(int argc, char* argv[]) {
         // Create the root directory
         create_root_directory(root_path);
 
+        // Replay the journal to restore the index and finish interrupted operations
+        minidrive::Journal journal(root_path);
+        auto start = std::chrono::steady_clock::now();
+        auto stats = journal.recover();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Recovered " << journal.size() << " entries in " << elapsed.count() << " ms ("
+                  << (stats.scanned_tree ? "full scan" : std::to_string(stats.checkpoint_entries) + " from checkpoint") << ", "
+                  << stats.replayed_records << " journal records replayed, "
+                  << stats.redone_operations << " operations redone, "
+                  << stats.skipped_operations << " skipped)\n";
+
         std::cout << "Server starting on port: " << port << " with root path: " << root_path << "\n";
 
-        run_server("0.0.0.0", port, root_path);
+        run_server("0.0.0.0", port, root_path, journal);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
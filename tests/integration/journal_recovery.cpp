@@ -0,0 +1,383 @@
+#include "minidrive/journal.hpp"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Drives minidrive::Journal directly: index contents after each operation,
+// torn-tail truncation, redo of unfinished operations, carried in-flight
+// records, scanning without a checkpoint, automatic checkpoints, concurrent
+// commits and a failing journal write.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+fs::path fresh_root(const std::string& name) {
+    auto root = fs::temp_directory_path() / ("minidrive-test-" + std::to_string(::getpid()) + "-" + name);
+    fs::remove_all(root);
+    fs::create_directories(root / "u");
+    return root;
+}
+
+void write_file(const fs::path& path, const std::string& contents) {
+    std::ofstream output(path, std::ios::binary);
+    output << contents;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void append_journal(const fs::path& root, const std::string& text) {
+    std::ofstream output(root / ".minidrive" / "journal.log", std::ios::binary | std::ios::app);
+    output << text;
+}
+
+// Hand-written records that should replay must come after the checkpoint.
+std::uint64_t checkpoint_seq(const fs::path& root) {
+    std::ifstream input(root / ".minidrive" / "index.checkpoint");
+    std::string magic;
+    int format = 0;
+    std::uint64_t last_seq = 0;
+    input >> magic >> format >> last_seq;
+    return last_seq;
+}
+
+template <typename Function>
+bool throws(Function function) {
+    try {
+        function();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+void test_operations() {
+    auto root = fresh_root("operations");
+    minidrive::Journal journal(root);
+    journal.recover();
+
+    journal.commit_mkdir("u/docs");
+    check(journal.lookup("u/docs") && journal.lookup("u/docs")->is_directory, "mkdir is indexed");
+
+    auto staged = journal.staging_path();
+    write_file(staged, "hello");
+    journal.commit_upload(staged, "u/docs/a.txt", 5);
+    check(read_file(root / "u/docs/a.txt") == "hello", "upload lands at its final path");
+    check(journal.lookup("u/docs/a.txt") && journal.lookup("u/docs/a.txt")->size == 5, "upload is indexed");
+
+    auto before = journal.list("u")->version;
+    journal.commit_move("u/docs", "u/moved");
+    check(!journal.lookup("u/docs") && journal.lookup("u/moved/a.txt"), "move re-keys the subtree");
+    check(journal.list("u")->version != before, "move changes the parent version");
+    check(journal.list("u/moved")->entries.size() == 1, "listing shows the moved file");
+
+    check(throws([&]() { journal.commit_move("u/moved", "u/moved/inner"); }), "move into own subtree is rejected");
+    check(fs::exists(root / "u/moved") && journal.lookup("u/moved"), "rejected move leaves disk and index alone");
+    check(throws([&]() { journal.commit_mkdir("u/moved"); }), "mkdir of an existing path is rejected");
+
+    journal.commit_delete("u/moved");
+    check(!journal.lookup("u/moved") && !journal.lookup("u/moved/a.txt"), "delete drops the subtree");
+    check(!fs::exists(root / "u/moved"), "delete removes it from disk");
+    fs::remove_all(root);
+}
+
+void test_reopen() {
+    auto root = fresh_root("reopen");
+    {
+        minidrive::Journal journal(root);
+        journal.recover();
+        journal.commit_mkdir("u/a");
+        journal.commit_mkdir("u/b");
+        journal.commit_move("u/b", "u/a/b");
+    }
+    minidrive::Journal journal(root);
+    auto stats = journal.recover();
+    check(!stats.scanned_tree, "reopen uses the checkpoint");
+    check(journal.lookup("u/a/b") && !journal.lookup("u/b"), "reopen replays the journal");
+    check(stats.redone_operations == 0, "completed operations are not redone");
+    fs::remove_all(root);
+}
+
+void test_torn_tail() {
+    auto root = fresh_root("torn");
+    { minidrive::Journal(root).recover(); }
+    append_journal(root, "{\"op\":\"mkdir\",\"pa");
+    {
+        minidrive::Journal journal(root);
+        auto stats = journal.recover();
+        check(stats.replayed_records == 0, "torn record is not replayed");
+        check(fs::file_size(root / ".minidrive/journal.log") == 0, "torn tail is cut off");
+        journal.commit_mkdir("u/y");
+    }
+
+    auto seq = std::to_string(checkpoint_seq(root) + 90);
+    auto done_seq = std::to_string(checkpoint_seq(root) + 91);
+    append_journal(root, "{\"op\":\"mkdir\",\"path\":\"u/x\",\"seq\":" + seq + "}\n{\"op\":\"done\",\"ref\":" + seq +
+                         ",\"seq\":" + done_seq + "}\n");
+    append_journal(root, "{\"op\":\"delete\",\"path\":\"u/x\",\"se");
+    fs::create_directories(root / "u/x");
+
+    minidrive::Journal journal(root);
+    auto stats = journal.recover();
+    check(stats.replayed_records >= 2, "records before the tear are replayed");
+    check(journal.lookup("u/x") && journal.lookup("u/y"), "records before the tear survive");
+    check(fs::exists(root / "u/x"), "torn operation is not redone");
+    fs::remove_all(root);
+}
+
+void test_redo() {
+    auto root = fresh_root("redo");
+    fs::create_directories(root / "u/src");
+    fs::create_directories(root / "u/gone");
+    { minidrive::Journal(root).recover(); }
+    write_file(root / ".minidrive/staging/7.part", "payload");
+    append_journal(root,
+        "{\"op\":\"upload\",\"path\":\"u/up.txt\",\"seq\":1,\"size\":7,\"staged\":\"7.part\"}\n"
+        "{\"op\":\"move\",\"dst\":\"u/dst\",\"seq\":2,\"src\":\"u/src\"}\n"
+        "{\"op\":\"delete\",\"path\":\"u/gone\",\"seq\":3}\n"
+        "{\"op\":\"mkdir\",\"path\":\"u/aborted\",\"seq\":4}\n"
+        "{\"op\":\"abort\",\"ref\":4,\"seq\":5}\n");
+    write_file(root / ".minidrive/staging/99.part", "never journaled");
+
+    minidrive::Journal journal(root);
+    auto stats = journal.recover();
+    check(stats.redone_operations == 3, "three unfinished operations are redone");
+    check(read_file(root / "u/up.txt") == "payload" && journal.lookup("u/up.txt"), "unfinished upload is published");
+    check(fs::exists(root / "u/dst") && !fs::exists(root / "u/src") && journal.lookup("u/dst"), "unfinished move is redone");
+    check(!fs::exists(root / "u/gone") && !journal.lookup("u/gone"), "unfinished delete is redone");
+    check(!fs::exists(root / "u/aborted") && !journal.lookup("u/aborted"), "aborted operation is not redone");
+    check(fs::is_empty(root / ".minidrive/staging"), "unjournaled staged uploads are removed");
+    fs::remove_all(root);
+}
+
+void test_redo_failure_is_skipped() {
+    auto root = fresh_root("skip");
+    fs::create_directories(root / "u/a");
+    { minidrive::Journal(root).recover(); }
+    append_journal(root, "{\"op\":\"move\",\"dst\":\"u/a/b\",\"seq\":1,\"src\":\"u/a\"}\n");
+
+    minidrive::Journal journal(root);
+    minidrive::RecoveryStats stats;
+    check(!throws([&]() { stats = journal.recover(); }), "impossible redo does not stop startup");
+    check(stats.skipped_operations == 1, "impossible redo is counted as skipped");
+    check(fs::exists(root / "u/a") && journal.lookup("u/a") && !journal.lookup("u/a/b"), "index matches disk");
+
+    minidrive::Journal again(root);
+    check(!throws([&]() { again.recover(); }), "skipped record is gone after the checkpoint");
+    fs::remove_all(root);
+}
+
+void test_carried_records() {
+    // A checkpoint taken while an operation was in flight: the record's seq
+    // is covered by the checkpoint but it was copied into the new segment.
+    auto root = fresh_root("carried");
+    { minidrive::Journal(root).recover(); }
+    write_file(root / ".minidrive/index.checkpoint", "minidrive-index 1 5 1\nd 0 0 u\n");
+    write_file(root / ".minidrive/journal.log", "{\"op\":\"mkdir\",\"path\":\"u/late\",\"seq\":4}\n");
+
+    minidrive::Journal journal(root);
+    auto stats = journal.recover();
+    check(stats.checkpoint_entries == 1, "checkpoint is loaded");
+    check(stats.redone_operations == 1 && fs::is_directory(root / "u/late") && journal.lookup("u/late"),
+          "carried in-flight record is redone");
+    fs::remove_all(root);
+}
+
+void test_scan_without_checkpoint() {
+    auto root = fresh_root("scan");
+    fs::create_directories(root / "u/docs");
+    write_file(root / "u/docs/x.txt", "x");
+    fs::create_directories(root / ".minidrive");
+    write_file(root / ".minidrive/journal.log", "");
+
+    minidrive::Journal journal(root);
+    auto stats = journal.recover();
+    check(stats.scanned_tree, "a journal without a checkpoint still triggers a scan");
+    check(journal.lookup("u/docs/x.txt") && journal.list("u"), "existing files are indexed");
+    fs::remove_all(root);
+}
+
+void test_automatic_checkpoint() {
+    auto root = fresh_root("auto");
+    {
+        minidrive::Journal journal(root, minidrive::SyncMode::group, 10);
+        journal.recover();
+        for (int i = 0; i < 25; ++i) {
+            journal.commit_mkdir("u/d" + std::to_string(i));
+        }
+        check(fs::file_size(root / ".minidrive/journal.log") < 1000, "journal is trimmed while running");
+        check(!fs::exists(root / ".minidrive/journal.old"), "old segment is removed");
+    }
+    minidrive::Journal journal(root);
+    journal.recover();
+    check(journal.list("u")->entries.size() == 25, "nothing is lost across automatic checkpoints");
+    fs::remove_all(root);
+}
+
+void test_newline_in_name() {
+    auto root = fresh_root("newline");
+    fs::create_directories(root / "u/two\nlines");
+    write_file(root / "u/back\\slash", "x");
+    { minidrive::Journal(root).recover(); }
+
+    minidrive::Journal journal(root);
+    check(!throws([&]() { journal.recover(); }), "checkpoint with a newline in a name loads");
+    check(journal.lookup("u/two\nlines") && journal.lookup("u/back\\slash"), "escaped names survive the checkpoint");
+    fs::remove_all(root);
+}
+
+void test_concurrent_commits() {
+    auto root = fresh_root("concurrent");
+    minidrive::Journal journal(root);
+    journal.recover();
+
+    // Independent commits share journal syncs.
+    constexpr int threads = 16;
+    constexpr int per_thread = 20;
+    constexpr std::size_t commits = threads * per_thread;
+    auto syncs_before = journal.journal_sync_count();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&journal, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                journal.commit_mkdir("u/t" + std::to_string(t) + "-" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    check(journal.list("u")->entries.size() == commits, "every concurrent commit is indexed");
+    check(journal.journal_sync_count() - syncs_before < commits, "concurrent commits are batched");
+
+    // Commits on the same path run one at a time, so exactly one move wins.
+    journal.commit_mkdir("u/src");
+    std::atomic<int> moved{0};
+    workers.clear();
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&journal, &moved, t]() {
+            try {
+                journal.commit_move("u/src", "u/dst" + std::to_string(t));
+                ++moved;
+            } catch (const std::exception&) {
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    int on_disk = 0;
+    int indexed = 0;
+    for (int t = 0; t < 8; ++t) {
+        on_disk += fs::exists(root / ("u/dst" + std::to_string(t))) ? 1 : 0;
+        indexed += journal.lookup("u/dst" + std::to_string(t)) ? 1 : 0;
+    }
+    check(moved == 1 && on_disk == 1 && indexed == 1, "overlapping moves are serialised");
+    check(!journal.lookup("u/src") && !fs::exists(root / "u/src"), "the moved source is gone");
+    fs::remove_all(root);
+}
+
+void test_failed_write() {
+    auto root = fresh_root("failed");
+    {
+        minidrive::Journal journal(root);
+        journal.recover();
+        journal.commit_mkdir("u/ok");
+
+        // Let the journal grow by only a few bytes, so the next batch fails part-way.
+        auto journal_size = fs::file_size(root / ".minidrive/journal.log");
+        rlimit original{};
+        ::getrlimit(RLIMIT_FSIZE, &original);
+        auto previous_handler = std::signal(SIGXFSZ, SIG_IGN);
+        rlimit limited = original;
+        limited.rlim_cur = static_cast<rlim_t>(journal_size + 10);
+        ::setrlimit(RLIMIT_FSIZE, &limited);
+
+        std::string name = "u/" + std::string(100, 'x');
+        check(throws([&]() { journal.commit_mkdir(name); }), "a failed journal write fails the commit");
+        ::setrlimit(RLIMIT_FSIZE, &original);
+        std::signal(SIGXFSZ, previous_handler);
+
+        check(!fs::exists(root / name) && !journal.lookup(name), "a failed commit changes nothing");
+        check(throws([&]() { journal.commit_mkdir("u/later"); }), "the journal refuses commits after a failed write");
+        check(!fs::exists(root / "u/later"), "refused commits change nothing");
+    }
+
+    minidrive::Journal journal(root);
+    check(!throws([&]() { journal.recover(); }), "recovery after a failed write succeeds");
+    check(journal.lookup("u/ok") && !journal.lookup("u/" + std::string(100, 'x')), "only completed commits survive");
+    fs::remove_all(root);
+}
+
+void test_versions_do_not_repeat() {
+    auto root = fresh_root("versions");
+    fs::create_directories(root / "u/a/sub");
+    fs::create_directories(root / "u/b/sub");
+    write_file(root / "u/a/sub/f1", "1");
+    write_file(root / "u/b/sub/f2", "2");
+    minidrive::Journal journal(root);
+    journal.recover();
+
+    check(journal.list("u/a/sub")->version != journal.list("u/b/sub")->version, "scanned directories get distinct versions");
+    auto before = journal.list("u/a/sub")->version;
+    journal.commit_delete("u/a");
+    journal.commit_move("u/b", "u/a");
+    auto after = journal.list("u/a/sub");
+    check(after->entries.size() == 1 && after->entries.front().first == "f2", "moved subtree is listed at its new path");
+    check(after->version != before, "a moved-in directory does not repeat the old version");
+
+    // A rescan (checkpoint lost) must not hand out versions from before either.
+    auto highest = journal.list("u/a/sub")->version;
+    fs::remove(root / ".minidrive/index.checkpoint");
+    minidrive::Journal rescanned(root);
+    rescanned.recover();
+    check(rescanned.list("u/a/sub")->version > highest, "a rescan numbers versions above earlier ones");
+    check(rescanned.lookup("u/a/sub/f2") && !rescanned.lookup("u/b"), "completed records are not replayed onto a scan");
+    fs::remove_all(root);
+}
+
+} // namespace
+
+int main() {
+    test_operations();
+    test_reopen();
+    test_torn_tail();
+    test_redo();
+    test_redo_failure_is_skipped();
+    test_carried_records();
+    test_scan_without_checkpoint();
+    test_automatic_checkpoint();
+    test_newline_in_name();
+    test_concurrent_commits();
+    test_failed_write();
+    test_versions_do_not_repeat();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All journal checks passed" << std::endl;
+    return 0;
+}
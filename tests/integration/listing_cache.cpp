@@ -0,0 +1,116 @@
+#include "minidrive/listing_cache.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Client-side listing cache and remote path helpers.
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+minidrive::Listing listing_of(std::uint64_t version, std::initializer_list<minidrive::RemoteEntry> entries) {
+    minidrive::Listing listing;
+    listing.version = version;
+    listing.entries = entries;
+    return listing;
+}
+
+void test_resolve_remote_path() {
+    using minidrive::resolve_remote_path;
+    check(resolve_remote_path("/", ".") == "/", "'.' at the root is the root");
+    check(resolve_remote_path("/docs", "a.txt") == "/docs/a.txt", "relative paths join the cwd");
+    check(resolve_remote_path("/docs", "/x/y") == "/x/y", "absolute paths ignore the cwd");
+    check(resolve_remote_path("/docs/sub", "../b//./c/") == "/docs/b/c", "'..', '.' and repeated slashes are normalised");
+    check(resolve_remote_path("/docs", "..") == "/", "'..' can reach the root");
+
+    bool threw = false;
+    try {
+        resolve_remote_path("/docs", "../..");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "climbing above the root throws");
+}
+
+void test_parent_and_child() {
+    check(minidrive::remote_parent("/a/b") == "/a", "parent of a nested path");
+    check(minidrive::remote_parent("/a") == "/", "parent of a top-level path is the root");
+    check(minidrive::remote_parent("/") == "/", "the root is its own parent");
+    check(minidrive::remote_child("/", "a") == "/a", "child of the root");
+    check(minidrive::remote_child("/a", "b") == "/a/b", "child of a directory");
+}
+
+void test_invalidate_tree() {
+    minidrive::ListingCache cache(std::chrono::seconds(10));
+    cache.put("/", listing_of(1, {{"a", true, 0}, {"ab", true, 0}}));
+    cache.put("/a", listing_of(2, {{"b", true, 0}}));
+    cache.put("/a/b", listing_of(3, {}));
+    cache.put("/ab", listing_of(4, {}));
+
+    cache.invalidate_tree("/a");
+    check(!cache.get("/a") && !cache.get("/a/b"), "the directory and everything below it are dropped");
+    check(cache.get("/") && cache.get("/ab"), "the parent and siblings sharing a prefix are kept");
+
+    cache.invalidate_tree("/");
+    check(!cache.get("/") && !cache.get("/ab"), "invalidating the root drops everything");
+}
+
+void test_stat_and_complete() {
+    minidrive::ListingCache cache(std::chrono::seconds(10));
+    cache.put("/", listing_of(1, {{"docs", true, 0}, {"data.bin", false, 42}, {"notes.txt", false, 7}}));
+
+    auto docs = cache.stat("/docs");
+    check(docs && docs->is_directory, "stat finds a directory in its parent's listing");
+    auto data = cache.stat("/data.bin");
+    check(data && !data->is_directory && data->size == 42, "stat reports file sizes");
+    check(!cache.stat("/missing"), "stat of an unknown name is empty");
+    check(!cache.stat("/docs/inner"), "stat without a cached parent is empty");
+    check(cache.stat("/") && cache.stat("/")->is_directory, "the root is always a directory");
+
+    auto matches = cache.complete("/", "d");
+    check(matches.size() == 2, "complete returns every name with the prefix");
+    check(cache.complete("/", "").size() == 3, "an empty prefix matches everything");
+    check(cache.complete("/", "x").empty(), "no match is an empty result");
+    check(cache.complete("/docs", "").empty(), "completing an uncached directory offers nothing");
+}
+
+void test_freshness() {
+    minidrive::ListingCache cache(std::chrono::milliseconds(50));
+    cache.put("/", listing_of(1, {}));
+    check(cache.is_fresh(*cache.get("/")), "a new listing is fresh");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    auto stale = cache.get("/");
+    check(stale && !cache.is_fresh(*stale), "an old listing is still served but stale");
+
+    cache.revalidated("/");
+    check(cache.is_fresh(*cache.get("/")), "revalidation makes it fresh again");
+}
+
+} // namespace
+
+int main() {
+    test_resolve_remote_path();
+    test_parent_and_child();
+    test_invalidate_tree();
+    test_stat_and_complete();
+    test_freshness();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All listing cache checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "minidrive/journal.hpp"
+#include "minidrive/listing.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+// LIST replies built from the journal index: the "if_version" /
+// "not_modified" exchange and when directory versions change.
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+json list(const minidrive::Journal& journal, const std::string& path, const json& args = json::object()) {
+    return minidrive::listing_data(*journal.list(path), args);
+}
+
+void test_if_version() {
+    auto root = fs::temp_directory_path() / ("minidrive-test-" + std::to_string(::getpid()) + "-listing");
+    fs::remove_all(root);
+    fs::create_directories(root / "u");
+    minidrive::Journal journal(root);
+    journal.recover();
+    journal.commit_mkdir("u/docs");
+
+    auto full = list(journal, "u");
+    check(full.contains("entries") && full.at("entries").size() == 1, "a plain LIST returns the entries");
+    check(full.at("entries").at(0).at("name") == "docs" && full.at("entries").at(0).at("type") == "dir",
+          "entries carry name and type");
+    auto version = full.at("version").get<std::uint64_t>();
+
+    auto unchanged = list(journal, "u", {{"if_version", version}});
+    check(unchanged.value("not_modified", false) && !unchanged.contains("entries"), "a matching if_version is not modified");
+    check(unchanged.at("version") == version, "a not-modified reply still carries the version");
+
+    auto mismatch = list(journal, "u", {{"if_version", version + 1}});
+    check(!mismatch.contains("not_modified") && mismatch.contains("entries"), "another if_version gets the entries");
+
+    // Changes to a child's contents do not touch the parent's listing...
+    journal.commit_mkdir("u/docs/inner");
+    check(list(journal, "u", {{"if_version", version}}).value("not_modified", false),
+          "a change below a child keeps the parent's version");
+
+    // ...but changes to its direct children do.
+    auto docs_version = list(journal, "u/docs").at("version").get<std::uint64_t>();
+    journal.commit_move("u/docs/inner", "u/moved");
+    auto changed = list(journal, "u", {{"if_version", version}});
+    check(!changed.contains("not_modified") && changed.at("entries").size() == 2, "adding a child changes the version");
+    check(!list(journal, "u/docs", {{"if_version", docs_version}}).contains("not_modified"),
+          "removing a child changes the version");
+    fs::remove_all(root);
+}
+
+} // namespace
+
+int main() {
+    test_if_version();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All listing version checks passed" << std::endl;
+    return 0;
+}